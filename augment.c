@@ -0,0 +1,219 @@
+/* augment.c */
+
+#include "augment.h"
+#include "rng.h"
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void augment_defaults(AugmentConfig *cfg) {
+    cfg->enabled       = 0;
+    cfg->max_shift     = 2.0f;
+    cfg->max_rotate    = 10.0f;
+    cfg->max_scale     = 0.1f;
+    cfg->max_shear     = 0.0f;
+    cfg->elastic_alpha = 0.0f;
+    cfg->elastic_sigma = 4.0f;
+    cfg->noise_std     = 0.0f;
+}
+
+// Elastic displacements live on a coarse grid with this spacing
+static float grid_spacing(const AugmentConfig *cfg) {
+    return cfg->elastic_sigma > 1.0f ? cfg->elastic_sigma : 1.0f;
+}
+
+static int grid_dim(int pixels, float spacing) {
+    return (int)ceilf((float)(pixels - 1) / spacing) + 2;
+}
+
+int augment_scratch_size(const AugmentConfig *cfg, int width, int height) {
+    float g = grid_spacing(cfg);
+    // per-pixel dx, dy + grid dx, dy
+    return 2 * width * height + 2 * grid_dim(width, g) * grid_dim(height, g);
+}
+
+// uniform in [-limit, limit]
+static float symmetric(Rng *rng, float limit) {
+    return (2.0f * rng_uniform(rng) - 1.0f) * limit;
+}
+
+static float pixel_at(const float *src, int w, int h, int x, int y) {
+    return (x >= 0 && x < w && y >= 0 && y < h) ? src[y * w + x] : 0.0f;
+}
+
+// Bilinear sample at (sx, sy); outside the image reads as background (0)
+static float sample_bilinear(const float *src, int w, int h, float sx, float sy) {
+    // also rejects NaN/inf, which must not reach the float -> int conversion
+    if (!(fabsf(sx) < 1e6f && fabsf(sy) < 1e6f)) return 0.0f;
+    float fx = floorf(sx), fy = floorf(sy);
+    int x0 = (int)fx, y0 = (int)fy;
+    float wx = sx - fx, wy = sy - fy;
+    float top = (1.0f - wx) * pixel_at(src, w, h, x0, y0)     + wx * pixel_at(src, w, h, x0 + 1, y0);
+    float bot = (1.0f - wx) * pixel_at(src, w, h, x0, y0 + 1) + wx * pixel_at(src, w, h, x0 + 1, y0 + 1);
+    return (1.0f - wy) * top + wy * bot;
+}
+
+/*
+ * Fills the per-pixel elastic displacement field. Random displacements are
+ * drawn on a coarse grid (spacing = elastic_sigma) and bilinearly upsampled,
+ * a cheap stand-in for Gaussian-smoothing a dense random field.
+ */
+static void elastic_field(const AugmentConfig *cfg, Rng *rng, int w, int h,
+                          float *dx, float *dy, float *grid) {
+    float g = grid_spacing(cfg);
+    int gw = grid_dim(w, g), gh = grid_dim(h, g);
+    float *gx = grid, *gy = grid + gw * gh;
+    for (int i = 0; i < gw * gh; i++) {
+        gx[i] = symmetric(rng, cfg->elastic_alpha);
+        gy[i] = symmetric(rng, cfg->elastic_alpha);
+    }
+
+    float inv_g = 1.0f / g;
+    for (int y = 0; y < h; y++) {
+        float fy = (float)y * inv_g;
+        int y0 = (int)fy;
+        float wy = fy - (float)y0;
+        for (int x = 0; x < w; x++) {
+            float fx = (float)x * inv_g;
+            int x0 = (int)fx;
+            float wx = fx - (float)x0;
+            int i00 = y0 * gw + x0;
+            int i10 = i00 + gw;
+            dx[y * w + x] = (1.0f - wy) * ((1.0f - wx) * gx[i00] + wx * gx[i00 + 1])
+                          +         wy  * ((1.0f - wx) * gx[i10] + wx * gx[i10 + 1]);
+            dy[y * w + x] = (1.0f - wy) * ((1.0f - wx) * gy[i00] + wx * gy[i00 + 1])
+                          +         wy  * ((1.0f - wx) * gy[i10] + wx * gy[i10 + 1]);
+        }
+    }
+}
+
+/*
+ * Resamples one row: destination pixel x reads the source at
+ * (bx + ax * x + dx[x], by + ay * x + dy[x]). dx/dy may be NULL.
+ */
+static void warp_row(const float *src, int w, int h, float *out,
+                     float bx, float ax, float by, float ay,
+                     const float *dx, const float *dy) {
+    int x = 0;
+#ifdef __SSE2__
+    // 4 pixels at a time: vector coordinates and blend, scalar corner fetches
+    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 one  = _mm_set1_ps(1.0f);
+    for (; x + 4 <= w; x += 4) {
+        __m128 xs = _mm_add_ps(_mm_set1_ps((float)x), lane);
+        __m128 sx = _mm_add_ps(_mm_set1_ps(bx), _mm_mul_ps(_mm_set1_ps(ax), xs));
+        __m128 sy = _mm_add_ps(_mm_set1_ps(by), _mm_mul_ps(_mm_set1_ps(ay), xs));
+        if (dx) {
+            sx = _mm_add_ps(sx, _mm_loadu_ps(dx + x));
+            sy = _mm_add_ps(sy, _mm_loadu_ps(dy + x));
+        }
+
+        // floor(): truncate, then step down where truncation rounded up
+        __m128 fx = _mm_cvtepi32_ps(_mm_cvttps_epi32(sx));
+        __m128 fy = _mm_cvtepi32_ps(_mm_cvttps_epi32(sy));
+        fx = _mm_sub_ps(fx, _mm_and_ps(_mm_cmpgt_ps(fx, sx), one));
+        fy = _mm_sub_ps(fy, _mm_and_ps(_mm_cmpgt_ps(fy, sy), one));
+        __m128 wx = _mm_sub_ps(sx, fx);
+        __m128 wy = _mm_sub_ps(sy, fy);
+
+        int ix[4], iy[4];
+        _mm_storeu_si128((__m128i*)ix, _mm_cvttps_epi32(fx));
+        _mm_storeu_si128((__m128i*)iy, _mm_cvttps_epi32(fy));
+        float p00[4], p01[4], p10[4], p11[4];
+        for (int k = 0; k < 4; k++) {
+            p00[k] = pixel_at(src, w, h, ix[k],     iy[k]);
+            p01[k] = pixel_at(src, w, h, ix[k] + 1, iy[k]);
+            p10[k] = pixel_at(src, w, h, ix[k],     iy[k] + 1);
+            p11[k] = pixel_at(src, w, h, ix[k] + 1, iy[k] + 1);
+        }
+
+        __m128 iwx = _mm_sub_ps(one, wx);
+        __m128 top = _mm_add_ps(_mm_mul_ps(iwx, _mm_loadu_ps(p00)), _mm_mul_ps(wx, _mm_loadu_ps(p01)));
+        __m128 bot = _mm_add_ps(_mm_mul_ps(iwx, _mm_loadu_ps(p10)), _mm_mul_ps(wx, _mm_loadu_ps(p11)));
+        __m128 v   = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, wy), top), _mm_mul_ps(wy, bot));
+
+        // same rule as sample_bilinear(): NaN/inf/huge coordinates read as background
+        __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        __m128 limit    = _mm_set1_ps(1e6f);
+        __m128 valid    = _mm_and_ps(_mm_cmplt_ps(_mm_and_ps(sx, abs_mask), limit),
+                                     _mm_cmplt_ps(_mm_and_ps(sy, abs_mask), limit));
+        _mm_storeu_ps(out + x, _mm_and_ps(v, valid));
+    }
+#endif
+    for (; x < w; x++) {
+        float sx = bx + ax * (float)x + (dx ? dx[x] : 0.0f);
+        float sy = by + ay * (float)x + (dy ? dy[x] : 0.0f);
+        out[x] = sample_bilinear(src, w, h, sx, sy);
+    }
+}
+
+// dst = clamp(dst + noise, 0, 1)
+static void add_noise_clamped(float *dst, const float *noise, int n) {
+    int i = 0;
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(noise + i));
+        _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(v, zero), one));
+    }
+#endif
+    for (; i < n; i++) {
+        float v = dst[i] + noise[i];
+        dst[i] = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+    }
+}
+
+void augment_image(const AugmentConfig *cfg, uint64_t seed, uint64_t key,
+                   const float *src, float *dst, int width, int height, float *scratch) {
+    int w = width, h = height, n = width * height;
+    Rng rng;
+    rng_init(&rng, seed, rng_substream(RNG_STREAM_AUGMENT, key));
+
+    // 1) Draw the affine parameters (always in this order, so streams stay stable)
+    float tx    = symmetric(&rng, cfg->max_shift);
+    float ty    = symmetric(&rng, cfg->max_shift);
+    float theta = symmetric(&rng, cfg->max_rotate) * (3.14159265358979f / 180.0f);
+    float scale = 1.0f + symmetric(&rng, cfg->max_scale);
+    float shear = symmetric(&rng, cfg->max_shear);
+
+    // 2) Inverse mapping, destination -> source, about the image center:
+    //    src = c + (1/scale) * Shear^-1 * R^-1 * (dst - c - t)
+    float cs = cosf(theta), sn = sinf(theta);
+    float inv_s = 1.0f / scale;
+    float m00 = inv_s * (cs + shear * sn);
+    float m01 = inv_s * (sn - shear * cs);
+    float m10 = inv_s * (-sn);
+    float m11 = inv_s * cs;
+    float cx = 0.5f * (float)(w - 1), cy = 0.5f * (float)(h - 1);
+
+    // 3) Optional elastic displacement field
+    float *dx = NULL, *dy = NULL;
+    if (cfg->elastic_alpha > 0.0f) {
+        dx = scratch;
+        dy = scratch + n;
+        elastic_field(cfg, &rng, w, h, dx, dy, scratch + 2 * n);
+    }
+
+    // 4) Resample row by row
+    for (int y = 0; y < h; y++) {
+        float qx = -cx - tx;
+        float qy = (float)y - cy - ty;
+        float bx = cx + m00 * qx + m01 * qy;
+        float by = cy + m10 * qx + m11 * qy;
+        warp_row(src, w, h, dst + y * w, bx, m00, by, m10,
+                 dx ? dx + y * w : NULL, dy ? dy + y * w : NULL);
+    }
+
+    // 5) Optional additive Gaussian noise
+    if (cfg->noise_std > 0.0f) {
+        float *noise = scratch;   // the displacement field is no longer needed
+        for (int i = 0; i < n; i++) {
+            noise[i] = cfg->noise_std * rng_normal(&rng);
+        }
+        add_noise_clamped(dst, noise, n);
+    }
+}
@@ -0,0 +1,49 @@
+/* augment.h */
+
+#ifndef AUGMENT_H
+#define AUGMENT_H
+
+#include <stdint.h>
+
+/*
+ * On-the-fly image augmentation for single-channel images with pixels in
+ * [0, 1] and a zero background (e.g. MNIST).
+ *
+ * Each sample gets its own random affine warp (shift, rotation, scale,
+ * shear), optional elastic distortion and optional Gaussian noise, drawn
+ * from the counter-based RNG keyed by (seed, key). Using a key such as
+ * epoch * num_samples + sample_index gives every epoch fresh variants while
+ * staying reproducible for any batch size or thread count.
+ */
+typedef struct {
+    int enabled;
+    float max_shift;      // translation, uniform in +/- pixels
+    float max_rotate;     // rotation, uniform in +/- degrees
+    float max_scale;      // zoom, uniform in 1 +/- max_scale; must be in [0, 1)
+    float max_shear;      // horizontal shear factor, uniform in +/- max_shear
+    float elastic_alpha;  // elastic displacement in pixels (0 disables)
+    float elastic_sigma;  // elastic smoothness: spacing of the displacement grid in pixels
+    float noise_std;      // additive Gaussian noise std (0 disables)
+} AugmentConfig;
+
+/**
+ * @brief Fills `cfg` with moderate defaults (disabled until enabled = 1).
+ */
+void augment_defaults(AugmentConfig *cfg);
+
+/**
+ * @brief Number of floats of scratch space augment_image() needs.
+ */
+int augment_scratch_size(const AugmentConfig *cfg, int width, int height);
+
+/**
+ * @brief Writes an augmented copy of `src` into `dst` (both width * height).
+ *
+ * @param seed     Run seed.
+ * @param key      Per-sample key selecting the random stream.
+ * @param scratch  At least augment_scratch_size() floats; one buffer per thread.
+ */
+void augment_image(const AugmentConfig *cfg, uint64_t seed, uint64_t key,
+                   const float *src, float *dst, int width, int height, float *scratch);
+
+#endif // AUGMENT_H
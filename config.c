@@ -0,0 +1,314 @@
+/* config.c */
+
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>     // for sysconf()
+
+void config_defaults(TrainConfig *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_layers = 3;
+    cfg->layer_sizes[0] = 784;
+    cfg->layer_sizes[1] = 128;
+    cfg->layer_sizes[2] = 10;
+
+    cfg->epochs        = 5;
+    cfg->batch_size    = 1;
+    cfg->threads       = 1;
+    cfg->learning_rate = 0.01f;
+    cfg->optimizer     = OPT_SGD;
+    strcpy(cfg->precision, "fp32");
+    cfg->init          = INIT_XAVIER;
+    cfg->seed          = NN_DEFAULT_SEED;
+    cfg->shuffle       = 1;
+
+    strcpy(cfg->train_images, "train-images.idx3-ubyte");
+    strcpy(cfg->train_labels, "train-labels.idx1-ubyte");
+    strcpy(cfg->test_images,  "t10k-images.idx3-ubyte");
+    strcpy(cfg->test_labels,  "t10k-labels.idx1-ubyte");
+    strcpy(cfg->checkpoint_path, "checkpoint-%d.bin");
+
+    augment_defaults(&cfg->aug);
+}
+
+/* ---- value parsers: each returns 0 on success ---- */
+
+static int parse_int(const char *s, int min, int *out) {
+    char *end;
+    errno = 0;
+    long v = strtol(s, &end, 10);
+    if (errno || end == s || *end != '\0' || v < min || v > 1000000000L) return 1;
+    *out = (int)v;
+    return 0;
+}
+
+static int parse_float(const char *s, float *out) {
+    char *end;
+    errno = 0;
+    float v = strtof(s, &end);
+    if (errno || end == s || *end != '\0') return 1;
+    *out = v;
+    return 0;
+}
+
+static int parse_positive_float(const char *s, float *out) {
+    float v;
+    if (parse_float(s, &v) || !isfinite(v) || v <= 0.0f) return 1;
+    *out = v;
+    return 0;
+}
+
+static int parse_nonneg_float(const char *s, float *out) {
+    float v;
+    if (parse_float(s, &v) || !isfinite(v) || v < 0.0f) return 1;
+    *out = v;
+    return 0;
+}
+
+static int parse_u64(const char *s, uint64_t *out) {
+    char *end;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 0);
+    if (errno || end == s || *end != '\0' || s[0] == '-') return 1;
+    *out = (uint64_t)v;
+    return 0;
+}
+
+static int parse_bool(const char *s, int *out) {
+    if (!strcmp(s, "1") || !strcmp(s, "true") || !strcmp(s, "yes") || !strcmp(s, "on")) {
+        *out = 1;
+    } else if (!strcmp(s, "0") || !strcmp(s, "false") || !strcmp(s, "no") || !strcmp(s, "off")) {
+        *out = 0;
+    } else {
+        return 1;
+    }
+    return 0;
+}
+
+static int parse_path(const char *s, char *out) {
+    if (strlen(s) >= CONFIG_MAX_PATH) return 1;
+    strcpy(out, s);
+    return 0;
+}
+
+// "784,128,10" -> layer_sizes
+static int parse_layers(const char *s, TrainConfig *cfg) {
+    int sizes[CONFIG_MAX_LAYERS];
+    int n = 0;
+    const char *p = s;
+    while (*p) {
+        // copy one comma-separated field and validate it like any other int
+        char field[32];
+        size_t len = strcspn(p, ",");
+        if (len == 0 || len >= sizeof(field) || n == CONFIG_MAX_LAYERS) return 1;
+        memcpy(field, p, len);
+        field[len] = '\0';
+        if (parse_int(field, 1, &sizes[n++])) return 1;
+        p += len;
+        if (*p == ',' && *++p == '\0') return 1;   // trailing comma
+    }
+    if (n < 2) return 1;
+    cfg->num_layers = n;
+    memcpy(cfg->layer_sizes, sizes, n * sizeof(int));
+    return 0;
+}
+
+// 0 (one per CPU) up to CONFIG_MAX_THREADS_PER_CPU threads per online CPU
+static int parse_threads(const char *s, int *out) {
+    int v;
+    if (parse_int(s, 0, &v)) return 1;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long limit = (cpus > 0 ? cpus : 1) * CONFIG_MAX_THREADS_PER_CPU;
+    if (v > limit) {
+        fprintf(stderr, "threads must be at most %ld on this machine\n", limit);
+        return 1;
+    }
+    *out = v;
+    return 0;
+}
+
+static int parse_init(const char *s, InitScheme *out) {
+    if (!strcmp(s, "uniform"))     *out = INIT_UNIFORM;
+    else if (!strcmp(s, "xavier")) *out = INIT_XAVIER;
+    else if (!strcmp(s, "he"))     *out = INIT_HE;
+    else return 1;
+    return 0;
+}
+
+int config_set(TrainConfig *cfg, const char *key_in, const char *value) {
+    // normalize underscores to dashes so both "batch_size" and "batch-size" work
+    char key[64];
+    size_t len = strlen(key_in);
+    if (len >= sizeof(key)) {
+        fprintf(stderr, "Unknown setting: %s\n", key_in);
+        return 1;
+    }
+    for (size_t i = 0; i <= len; i++) {
+        key[i] = key_in[i] == '_' ? '-' : key_in[i];
+    }
+
+    int err;
+    if      (!strcmp(key, "layers"))           err = parse_layers(value, cfg);
+    else if (!strcmp(key, "epochs"))           err = parse_int(value, 0, &cfg->epochs);
+    else if (!strcmp(key, "batch-size"))       err = parse_int(value, 1, &cfg->batch_size);
+    else if (!strcmp(key, "threads"))          err = parse_threads(value, &cfg->threads);
+    else if (!strcmp(key, "lr"))               err = parse_positive_float(value, &cfg->learning_rate);
+    else if (!strcmp(key, "optimizer"))        err = parse_optimizer(value, &cfg->optimizer);
+    else if (!strcmp(key, "init"))             err = parse_init(value, &cfg->init);
+    else if (!strcmp(key, "init-from"))        err = parse_path(value, cfg->init_from);
+    else if (!strcmp(key, "seed"))             err = parse_u64(value, &cfg->seed);
+    else if (!strcmp(key, "shuffle"))          err = parse_bool(value, &cfg->shuffle);
+    else if (!strcmp(key, "train-images"))     err = parse_path(value, cfg->train_images);
+    else if (!strcmp(key, "train-labels"))     err = parse_path(value, cfg->train_labels);
+    else if (!strcmp(key, "test-images"))      err = parse_path(value, cfg->test_images);
+    else if (!strcmp(key, "test-labels"))      err = parse_path(value, cfg->test_labels);
+    else if (!strcmp(key, "eval-every"))       err = parse_int(value, 0, &cfg->eval_every);
+    else if (!strcmp(key, "checkpoint-every")) err = parse_int(value, 0, &cfg->checkpoint_every);
+    else if (!strcmp(key, "checkpoint-path"))  err = parse_path(value, cfg->checkpoint_path);
+    else if (!strcmp(key, "log"))              err = parse_path(value, cfg->log_path);
+    else if (!strcmp(key, "augment"))          err = parse_bool(value, &cfg->aug.enabled);
+    else if (!strcmp(key, "aug-shift"))        err = parse_nonneg_float(value, &cfg->aug.max_shift);
+    else if (!strcmp(key, "aug-rotate"))       err = parse_nonneg_float(value, &cfg->aug.max_rotate);
+    else if (!strcmp(key, "aug-scale")) {
+        // scale = 1 +/- max_scale must stay positive, or the warp collapses or mirrors
+        err = parse_nonneg_float(value, &cfg->aug.max_scale) || cfg->aug.max_scale >= 1.0f;
+    }
+    else if (!strcmp(key, "aug-shear"))        err = parse_nonneg_float(value, &cfg->aug.max_shear);
+    else if (!strcmp(key, "aug-elastic-alpha")) err = parse_nonneg_float(value, &cfg->aug.elastic_alpha);
+    else if (!strcmp(key, "aug-elastic-sigma")) err = parse_nonneg_float(value, &cfg->aug.elastic_sigma);
+    else if (!strcmp(key, "aug-noise"))        err = parse_nonneg_float(value, &cfg->aug.noise_std);
+    else if (!strcmp(key, "precision")) {
+        // Only single precision exists in the network code today
+        if (strcmp(value, "fp32") != 0) {
+            fprintf(stderr, "Unsupported precision '%s' (only fp32 is implemented)\n", value);
+            return 1;
+        }
+        strcpy(cfg->precision, value);
+        err = 0;
+    }
+    else {
+        fprintf(stderr, "Unknown setting: %s\n", key_in);
+        return 1;
+    }
+
+    if (err) {
+        fprintf(stderr, "Invalid value for %s: '%s'\n", key_in, value);
+        return 1;
+    }
+    return 0;
+}
+
+// strip leading/trailing whitespace in place
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return s;
+}
+
+int config_load_file(TrainConfig *cfg, const char *filepath) {
+    FILE *fp = fopen(filepath, "r");
+    if (!fp) {
+        fprintf(stderr, "Cannot open config file: %s\n", filepath);
+        return 1;
+    }
+
+    char line[1024];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        char *s = trim(line);
+        if (*s == '\0' || *s == '#') continue;
+
+        char *eq = strchr(s, '=');
+        if (!eq) {
+            fprintf(stderr, "%s:%d: expected 'key = value'\n", filepath, line_no);
+            fclose(fp);
+            return 1;
+        }
+        *eq = '\0';
+        if (config_set(cfg, trim(s), trim(eq + 1)) != 0) {
+            fprintf(stderr, "%s:%d: invalid setting\n", filepath, line_no);
+            fclose(fp);
+            return 1;
+        }
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+int config_parse_args(TrainConfig *cfg, int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) return 2;
+        if (strncmp(arg, "--", 2) != 0) {
+            fprintf(stderr, "Unexpected argument: %s\n", arg);
+            return 1;
+        }
+
+        // split "--key=value", otherwise take the value from the next argument
+        char key[64];
+        const char *value;
+        const char *eq = strchr(arg + 2, '=');
+        size_t key_len = eq ? (size_t)(eq - (arg + 2)) : strlen(arg + 2);
+        if (key_len >= sizeof(key)) {
+            fprintf(stderr, "Unknown option: %s\n", arg);
+            return 1;
+        }
+        memcpy(key, arg + 2, key_len);
+        key[key_len] = '\0';
+
+        if (eq) {
+            value = eq + 1;
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            fprintf(stderr, "Missing value for %s\n", arg);
+            return 1;
+        }
+
+        int err = !strcmp(key, "config") ? config_load_file(cfg, value)
+                                         : config_set(cfg, key, value);
+        if (err) return 1;
+    }
+    return 0;
+}
+
+void config_print_usage(FILE *out, const char *prog) {
+    fprintf(out,
+        "Usage: %s [--config FILE] [--key value | --key=value ...]\n"
+        "\n"
+        "  --config FILE           load 'key = value' settings (same keys as below)\n"
+        "  --layers 784,128,10     layer sizes, input to output\n"
+        "  --epochs N              training epochs (default 5)\n"
+        "  --batch-size N          samples per update (default 1)\n"
+        "  --threads N             worker threads, 0 = one per CPU, at most %d per CPU (default 1)\n"
+        "  --lr X                  learning rate, > 0 (default 0.01)\n"
+        "  --optimizer NAME        sgd | momentum | adam (default sgd)\n"
+        "  --precision NAME        fp32 (default fp32)\n"
+        "  --init NAME             uniform | xavier | he (default xavier)\n"
+        "  --init-from PATH        start from a checkpoint (its topology replaces --layers)\n"
+        "  --seed N                RNG seed for init and shuffling\n"
+        "  --shuffle BOOL          reshuffle every epoch (default 1)\n"
+        "  --train-images PATH     --train-labels PATH\n"
+        "  --test-images PATH      --test-labels PATH\n"
+        "  --eval-every N          test-set eval every N epochs, 0 = end only\n"
+        "  --checkpoint-every N    save every N epochs, 0 = never\n"
+        "  --checkpoint-path PATH  checkpoint file, may contain %%d for the epoch\n"
+        "  --log PATH              JSON-lines metrics log, '-' for stdout\n"
+        "\n"
+        "  --augment BOOL          augment training images per batch (default 0)\n"
+        "  --aug-shift PX          max translation in pixels (default 2)\n"
+        "  --aug-rotate DEG        max rotation in degrees (default 10)\n"
+        "  --aug-scale X           max zoom, 1 +/- X, X in [0, 1) (default 0.1)\n"
+        "  --aug-shear X           max shear factor (default 0)\n"
+        "  --aug-elastic-alpha PX  elastic displacement, 0 = off (default 0)\n"
+        "  --aug-elastic-sigma PX  elastic smoothness (default 4)\n"
+        "  --aug-noise STD         Gaussian pixel noise, 0 = off (default 0)\n",
+        prog, CONFIG_MAX_THREADS_PER_CPU);
+}
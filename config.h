@@ -0,0 +1,85 @@
+/* config.h */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "neuralnet.h"
+#include "optimizer.h"
+#include "augment.h"
+
+#define CONFIG_MAX_LAYERS 16
+#define CONFIG_MAX_PATH   512
+#define CONFIG_MAX_THREADS_PER_CPU 4
+
+/*
+ * Everything the training driver can be told, with defaults matching the
+ * original hardcoded run ({784,128,10}, 5 epochs, lr 0.01, per-sample SGD).
+ *
+ * Settings come from "key = value" lines in a config file and/or
+ * "--key value" / "--key=value" command-line flags; both use the same keys
+ * (dashes and underscores are interchangeable), and later settings win.
+ */
+typedef struct {
+    int num_layers;
+    int layer_sizes[CONFIG_MAX_LAYERS];   // "layers", e.g. 784,128,10
+
+    int epochs;
+    int batch_size;
+    int threads;              // <= 0: one per CPU
+    float learning_rate;      // "lr"
+    OptimizerType optimizer;  // sgd | momentum | adam
+    char precision[8];        // only "fp32" is implemented
+    InitScheme init;          // uniform | xavier | he
+    char init_from[CONFIG_MAX_PATH];      // checkpoint to start from (overrides layers/init)
+    uint64_t seed;
+    int shuffle;              // reshuffle training order every epoch
+
+    char train_images[CONFIG_MAX_PATH];
+    char train_labels[CONFIG_MAX_PATH];
+    char test_images[CONFIG_MAX_PATH];
+    char test_labels[CONFIG_MAX_PATH];
+
+    int eval_every;                       // evaluate test set every N epochs (0: only at the end)
+    int checkpoint_every;                 // save every N epochs (0: never)
+    char checkpoint_path[CONFIG_MAX_PATH];// may contain %d for the epoch number
+    char log_path[CONFIG_MAX_PATH];       // JSON-lines log; "-" is stdout, empty disables
+
+    AugmentConfig aug;        // "augment", "aug-shift", "aug-rotate", ...
+} TrainConfig;
+
+/**
+ * @brief Fills `cfg` with the default settings.
+ */
+void config_defaults(TrainConfig *cfg);
+
+/**
+ * @brief Sets one setting by key, e.g. ("batch-size", "64").
+ *
+ * @return 0 on success, non-zero on an unknown key or invalid value.
+ */
+int config_set(TrainConfig *cfg, const char *key, const char *value);
+
+/**
+ * @brief Applies every "key = value" line of a config file. Blank lines and
+ *        lines starting with '#' are ignored.
+ *
+ * @return 0 on success, non-zero on error.
+ */
+int config_load_file(TrainConfig *cfg, const char *filepath);
+
+/**
+ * @brief Applies command-line flags in order. "--config FILE" loads a file
+ *        at that point, so flags after it override the file.
+ *
+ * @return 0 on success, 1 on error, 2 if --help was requested.
+ */
+int config_parse_args(TrainConfig *cfg, int argc, char **argv);
+
+/**
+ * @brief Prints the supported flags.
+ */
+void config_print_usage(FILE *out, const char *prog);
+
+#endif // CONFIG_H
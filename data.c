@@ -25,6 +25,8 @@ void free_dataset(Dataset* ds) {
     ds->num_samples = 0;
     ds->num_features = 0;
     ds->num_classes = 0;
+    ds->image_width = 0;
+    ds->image_height = 0;
 }
 
 // Helper to reverse endian for int
@@ -94,6 +96,8 @@ int load_mnist(const char *image_filepath, const char *label_filepath, Dataset *
     ds->num_samples  = num_images;
     ds->num_features = rows * cols;    // e.g. 28*28 = 784
     ds->num_classes  = 10;            // MNIST digits 0..9
+    ds->image_width  = cols;
+    ds->image_height = rows;
 
     // Allocate ds->features
     ds->features = (float**) malloc(num_images * sizeof(float*));
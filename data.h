@@ -20,9 +20,12 @@ typedef struct {
     int num_classes;    // (Optional) for classification tasks
                         // e.g., 10 for MNIST digits. If not relevant, set 0 or 1.
 
+    int image_width;    // For image data: features are row-major pixels,
+    int image_height;   //   num_features == image_width * image_height.
+                        //   0 for non-image data.
+
     // Additional metadata fields are possible:
-    // e.g., image_width, image_height (for image data),
-    // or column names if CSV, etc.
+    // e.g., column names if CSV, etc.
 } Dataset;
 
 /**
@@ -1,122 +1,299 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>        // for time() in srand()
+#include <string.h>
+#include <time.h>        // for clock_gettime() epoch timing
+#include <math.h>        // for isfinite()
 #include "data.h"
 #include "neuralnet.h"
+#include "optimizer.h"
+#include "config.h"
+#include "train.h"
+#include "rng.h"
 
-int main() {
-    // 1) Seed the random number generator for random weight initialization
-    srand((unsigned int)time(NULL));
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static const char *init_name(InitScheme scheme) {
+    switch (scheme) {
+        case INIT_UNIFORM: return "uniform";
+        case INIT_HE:      return "he";
+        case INIT_XAVIER:
+        default:           return "xavier";
+    }
+}
+
+// Expands the first "%d" in the checkpoint path to the epoch number
+static void checkpoint_filename(char *out, size_t out_size, const char *pattern, int epoch) {
+    const char *pos = strstr(pattern, "%d");
+    if (!pos) {
+        snprintf(out, out_size, "%s", pattern);
+        return;
+    }
+    snprintf(out, out_size, "%.*s%d%s", (int)(pos - pattern), pattern, epoch, pos + 2);
+}
+
+// Writes s as a JSON string literal
+static void json_string(FILE *out, const char *s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c < 0x20)         fprintf(out, "\\u%04x", c);
+        else                       fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+// Writes a number, or null when it isn't finite (JSON has no inf/nan)
+static void json_number(FILE *out, const char *fmt, double v) {
+    if (isfinite(v)) fprintf(out, fmt, v);
+    else             fprintf(out, "null");
+}
+
+static void log_config(FILE *log, const TrainConfig *cfg, int num_threads, int train_samples) {
+    fprintf(log, "{\"event\":\"config\",\"layers\":[");
+    for (int i = 0; i < cfg->num_layers; i++) {
+        fprintf(log, "%s%d", i ? "," : "", cfg->layer_sizes[i]);
+    }
+    fprintf(log, "],\"epochs\":%d,\"batch_size\":%d,\"threads\":%d,\"lr\":%g,"
+                 "\"optimizer\":\"%s\",\"precision\":\"%s\",",
+            cfg->epochs, cfg->batch_size, num_threads, cfg->learning_rate,
+            optimizer_name(cfg->optimizer), cfg->precision);
+    // weights come either from a checkpoint or from the seeded init scheme
+    if (cfg->init_from[0] != '\0') {
+        fprintf(log, "\"init\":null,\"init_from\":");
+        json_string(log, cfg->init_from);
+    } else {
+        fprintf(log, "\"init\":\"%s\",\"init_from\":null", init_name(cfg->init));
+    }
+    fprintf(log, ",\"seed\":%llu,\"train_samples\":%d,\"augment\":",
+            (unsigned long long)cfg->seed, train_samples);
+    const AugmentConfig *a = &cfg->aug;
+    if (a->enabled) {
+        fprintf(log, "{\"shift\":%g,\"rotate\":%g,\"scale\":%g,\"shear\":%g,"
+                     "\"elastic_alpha\":%g,\"elastic_sigma\":%g,\"noise\":%g}}\n",
+                a->max_shift, a->max_rotate, a->max_scale, a->max_shear,
+                a->elastic_alpha, a->elastic_sigma, a->noise_std);
+    } else {
+        fprintf(log, "null}\n");
+    }
+    fflush(log);
+}
+
+int main(int argc, char **argv) {
+    // 1) Read the configuration (defaults < config file < command line)
+    TrainConfig cfg;
+    config_defaults(&cfg);
+    int rc = config_parse_args(&cfg, argc, argv);
+    if (rc == 2) {
+        config_print_usage(stdout, argv[0]);
+        return 0;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "Run '%s --help' for usage.\n", argv[0]);
+        return 1;
+    }
+
+    // Metrics go to the log; with "--log -" they own stdout, so chatter moves to stderr
+    FILE *log = NULL;
+    FILE *info = stdout;
+    if (strcmp(cfg.log_path, "-") == 0) {
+        log = stdout;
+        info = stderr;
+    } else if (cfg.log_path[0] != '\0') {
+        log = fopen(cfg.log_path, "w");
+        if (!log) {
+            fprintf(stderr, "Cannot open log file: %s\n", cfg.log_path);
+            return 1;
+        }
+    }
 
     // 2) Load MNIST training data
     Dataset train_data;
-    if (load_mnist("train-images.idx3-ubyte", "train-labels.idx1-ubyte", &train_data) != 0) {
-        printf("Failed to load MNIST training data.\n");
+    if (load_mnist(cfg.train_images, cfg.train_labels, &train_data) != 0) {
+        fprintf(stderr, "Failed to load MNIST training data.\n");
+        if (log && log != stdout) fclose(log);
         return 1;
     }
-    printf("Loaded %d training samples, each with %d features.\n",
-           train_data.num_samples, train_data.num_features);
+    fprintf(info, "Loaded %d training samples, each with %d features.\n",
+            train_data.num_samples, train_data.num_features);
 
     // 3) Load MNIST test data
     Dataset test_data;
-    if (load_mnist("t10k-images.idx3-ubyte", "t10k-labels.idx1-ubyte", &test_data) != 0) {
-        printf("Failed to load MNIST test data.\n");
+    if (load_mnist(cfg.test_images, cfg.test_labels, &test_data) != 0) {
+        fprintf(stderr, "Failed to load MNIST test data.\n");
         free_dataset(&train_data);
+        if (log && log != stdout) fclose(log);
         return 1;
     }
-    printf("Loaded %d test samples, each with %d features.\n",
-           test_data.num_samples, test_data.num_features);
+    fprintf(info, "Loaded %d test samples, each with %d features.\n",
+            test_data.num_samples, test_data.num_features);
 
-    // 4) Create Neural Network
-    NeuralNet net;
-    int num_layers = 3;
-    int layer_sizes[] = { 784, 128, 10 }; // MNIST: 784 input, 128 hidden, 10 output
-    init_network(&net, num_layers, layer_sizes);
+    // A checkpoint given with --init-from defines the topology and starting weights
+    NeuralNet net = {0};
+    if (cfg.init_from[0] != '\0') {
+        if (load_network(&net, cfg.init_from) != 0 || net.num_layers > CONFIG_MAX_LAYERS) {
+            fprintf(stderr, "Failed to load checkpoint %s.\n", cfg.init_from);
+            if (net.layer_sizes) free_network(&net);
+            free_dataset(&train_data);
+            free_dataset(&test_data);
+            if (log && log != stdout) fclose(log);
+            return 1;
+        }
+        cfg.num_layers = net.num_layers;
+        memcpy(cfg.layer_sizes, net.layer_sizes, net.num_layers * sizeof(int));
+        fprintf(info, "Initialized network from %s.\n", cfg.init_from);
+    } else {
+        init_network_ex(&net, cfg.num_layers, cfg.layer_sizes, cfg.init, cfg.seed, cfg.threads);
+    }
 
-    // 5) Training parameters
-    int epochs = 5;            // Run a few epochs
-    float learning_rate = 0.01f;
+    int num_inputs  = cfg.layer_sizes[0];
+    int num_outputs = cfg.layer_sizes[cfg.num_layers - 1];
+    if (num_inputs != train_data.num_features || num_inputs != test_data.num_features
+        || num_outputs < train_data.num_classes) {
+        fprintf(stderr, "Topology does not match the data (%d inputs, %d classes).\n",
+                train_data.num_features, train_data.num_classes);
+        free_network(&net);
+        free_dataset(&train_data);
+        free_dataset(&test_data);
+        if (log && log != stdout) fclose(log);
+        return 1;
+    }
+
+    // 4) Create optimizer and trainer
+    int status = 0;
+    int *order = NULL;
+    const float **batch_inputs = NULL;
+    int *batch_labels = NULL;
+    uint64_t *batch_keys = NULL;
+
+    Optimizer opt;
+    init_optimizer(&opt, cfg.optimizer, &net);
+
+    Trainer trainer;
+    init_trainer(&trainer, &net, cfg.threads);
+
+    if (cfg.aug.enabled) {
+        if (train_data.image_width * train_data.image_height != train_data.num_features) {
+            fprintf(stderr, "Augmentation needs image data.\n");
+            status = 1;
+            goto cleanup;
+        }
+        trainer_set_augment(&trainer, &cfg.aug, cfg.seed,
+                            train_data.image_width, train_data.image_height);
+    }
+
+    if (log) log_config(log, &cfg, trainer.num_threads, train_data.num_samples);
+
+    // 5) Per-batch views of the (shuffled) training set
+    int n_train = train_data.num_samples;
+    order        = (int*) malloc(n_train * sizeof(int));
+    batch_inputs = (const float**) malloc(cfg.batch_size * sizeof(float*));
+    batch_labels = (int*) malloc(cfg.batch_size * sizeof(int));
+    batch_keys   = (uint64_t*) malloc(cfg.batch_size * sizeof(uint64_t));
+    if (!order || !batch_inputs || !batch_labels || !batch_keys) {
+        fprintf(stderr, "Failed to allocate batch buffers.\n");
+        status = 1;
+        goto cleanup;
+    }
+    for (int i = 0; i < n_train; i++) {
+        order[i] = i;
+    }
+    Rng shuffle_rng;
+    rng_init(&shuffle_rng, cfg.seed, RNG_STREAM_SHUFFLE);
 
     // 6) Training loop
-    for (int e = 0; e < epochs; e++) {
+    for (int e = 0; e < cfg.epochs; e++) {
         float total_loss = 0.0f;
         int correct = 0;
+        double t0 = now_seconds();
 
-        for (int i = 0; i < train_data.num_samples; i++) {
-            // Convert label to one-hot vector
-            int label_int = (int)train_data.labels[i];
-            float target[10] = {0};
-            target[label_int] = 1.0f;
+        if (cfg.shuffle) rng_shuffle(&shuffle_rng, order, n_train);
 
-            // Perform backpropagation
-            backprop(&net, train_data.features[i], target, learning_rate);
+        for (int start = 0; start < n_train; start += cfg.batch_size) {
+            int n = n_train - start < cfg.batch_size ? n_train - start : cfg.batch_size;
+            for (int b = 0; b < n; b++) {
+                int i = order[start + b];
+                batch_inputs[b] = train_data.features[i];
+                batch_labels[b] = (int)train_data.labels[i];
+                // one augmentation stream per (epoch, sample)
+                batch_keys[b]   = (uint64_t)e * (uint64_t)n_train + (uint64_t)i;
+            }
+            total_loss += train_batch(&trainer, &net, &opt, cfg.learning_rate,
+                                      batch_inputs, batch_labels, batch_keys, n, &correct);
+        }
 
-            // Compute loss & accuracy
-            float output[10];
-            forward(&net, train_data.features[i], output);
+        double seconds = now_seconds() - t0;
+        int epoch = e + 1;
 
-            float sample_loss = 0.0f;
-            for (int j = 0; j < 10; j++) {
-                float diff = output[j] - target[j];
-                sample_loss += diff * diff;
-            }
-            total_loss += sample_loss;
-
-            // Determine predicted label (argmax)
-            int predicted = 0;
-            float max_val = output[0];
-            for (int j = 1; j < 10; j++) {
-                if (output[j] > max_val) {
-                    max_val = output[j];
-                    predicted = j;
-                }
-            }
-            if (predicted == label_int) {
-                correct++;
-            }
+        // Optional test-set evaluation
+        float test_acc = -1.0f;
+        if (cfg.eval_every > 0 && epoch % cfg.eval_every == 0) {
+            test_acc = 100.0f * (float)evaluate(&net, &test_data) / (float)test_data.num_samples;
         }
 
-        // Print training stats
-        float avg_loss = total_loss / train_data.num_samples;
-        float accuracy = 100.0f * (float)correct / (float)train_data.num_samples;
-        printf("Epoch %d/%d - Avg Loss: %.4f - Accuracy: %.2f%%\n",
-               (e + 1), epochs, avg_loss, accuracy);
-    }
+        // Print training stats (an epoch too short to time has no throughput)
+        float avg_loss = total_loss / n_train;
+        float accuracy = 100.0f * (float)correct / (float)n_train;
+        double samples_per_sec = seconds > 0.0 ? n_train / seconds : NAN;
+        fprintf(info, "Epoch %d/%d - Avg Loss: %.4f - Accuracy: %.2f%% - %.1f samples/s",
+                epoch, cfg.epochs, avg_loss, accuracy, samples_per_sec);
+        if (test_acc >= 0.0f) fprintf(info, " - Test Accuracy: %.2f%%", test_acc);
+        fprintf(info, "\n");
 
-    // 7) Test Model on Unseen Data
-    printf("\nEvaluating on Test Set...\n");
-
-    int test_correct = 0;
-    for (int i = 0; i < test_data.num_samples; i++) {
-        float output[10];
-        forward(&net, test_data.features[i], output);
-
-        // Determine predicted label
-        int predicted = 0;
-        float max_val = output[0];
-        for (int j = 1; j < 10; j++) {
-            if (output[j] > max_val) {
-                max_val = output[j];
-                predicted = j;
-            }
+        if (log) {
+            fprintf(log, "{\"event\":\"epoch\",\"epoch\":%d,\"loss\":", epoch);
+            json_number(log, "%.6f", avg_loss);
+            fprintf(log, ",\"train_acc\":%.4f,\"seconds\":%.6f,\"samples_per_sec\":",
+                    accuracy, seconds);
+            json_number(log, "%.2f", samples_per_sec);
+            fprintf(log, ",\"test_acc\":");
+            if (test_acc >= 0.0f) fprintf(log, "%.4f}\n", test_acc);
+            else                  fprintf(log, "null}\n");
+            fflush(log);
         }
 
-        // Compare with ground truth
-        int true_label = (int)test_data.labels[i];
-        if (predicted == true_label) {
-            test_correct++;
+        // Optional checkpoint
+        if (cfg.checkpoint_every > 0 && epoch % cfg.checkpoint_every == 0) {
+            char path[CONFIG_MAX_PATH + 16];
+            checkpoint_filename(path, sizeof(path), cfg.checkpoint_path, epoch);
+            if (save_network(&net, path) == 0) {
+                fprintf(info, "Saved checkpoint to %s\n", path);
+            }
         }
     }
 
+    // 7) Test Model on Unseen Data
+    fprintf(info, "\nEvaluating on Test Set...\n");
+    int test_correct = evaluate(&net, &test_data);
+
     // Print test accuracy
     float test_accuracy = 100.0f * (float)test_correct / (float)test_data.num_samples;
-    printf("Test Accuracy: %.2f%% (%d/%d correct)\n",
-           test_accuracy, test_correct, test_data.num_samples);
+    fprintf(info, "Test Accuracy: %.2f%% (%d/%d correct)\n",
+            test_accuracy, test_correct, test_data.num_samples);
+    if (log) {
+        fprintf(log, "{\"event\":\"final\",\"test_acc\":");
+        json_number(log, "%.4f", test_accuracy);
+        fprintf(log, ",\"test_correct\":%d,\"test_samples\":%d}\n",
+                test_correct, test_data.num_samples);
+        fflush(log);
+    }
 
     // 8) Cleanup
+cleanup:
+    free(order);
+    free(batch_inputs);
+    free(batch_labels);
+    free(batch_keys);
+    free_trainer(&trainer);
+    free_optimizer(&opt);
     free_network(&net);
     free_dataset(&train_data);
     free_dataset(&test_data);
+    if (log && log != stdout) fclose(log);
 
-    return 0;
+    return status;
 }
@@ -2,7 +2,10 @@
 #include <stdlib.h>     
 #include <string.h>     
 #include <math.h>       
+#include <pthread.h>
+#include <unistd.h>     // for sysconf()
 #include "neuralnet.h"
+#include "rng.h"
 
 //allocates memory for a 2d array
 static float** allocate_2d_array(int rows, int cols) {
@@ -35,14 +38,113 @@ static float sigmoidf_deriv(float x) {
     return s * (1.0f - s);
 }
 
+/*
+ * Parallel weight fill
+ * --------------------
+ * Each thread fills a contiguous range of rows of one weight matrix.
+ * weight[out_n][in_n] comes from counter (out_n * in_size + in_n) on the
+ * layer's own RNG stream, so the split between threads never changes the values.
+ */
+typedef struct {
+    float **weights;
+    int row_begin, row_end;
+    int in_size;
+    float limit;          // weights are uniform in [-limit, limit]
+    uint64_t seed;
+    uint64_t stream;
+} InitTask;
+
+static void *init_rows_worker(void *arg) {
+    const InitTask *t = (const InitTask*) arg;
+    for(int out_n = t->row_begin; out_n < t->row_end; out_n++) {
+        uint64_t base = (uint64_t)out_n * (uint64_t)t->in_size;
+        float *row = t->weights[out_n];
+        for(int in_n = 0; in_n < t->in_size; in_n++) {
+            float u = rng_uniform_at(t->seed, t->stream, base + in_n);
+            row[in_n] = (2.0f * u - 1.0f) * t->limit;
+        }
+    }
+    return NULL;
+}
+
+static float init_limit(InitScheme scheme, int fan_in, int fan_out) {
+    switch(scheme) {
+        case INIT_XAVIER: return sqrtf(6.0f / (float)(fan_in + fan_out));
+        case INIT_HE:     return sqrtf(6.0f / (float)fan_in);
+        case INIT_UNIFORM:
+        default:          return 0.5f;
+    }
+}
+
+static int resolve_threads(int num_threads) {
+    if (num_threads > 0) return num_threads;
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static void fill_weights(float **weights, int out_size, int in_size, float limit,
+                         uint64_t seed, uint64_t stream, int num_threads) {
+    // Not worth spawning threads for small layers
+    long long total = (long long)out_size * in_size;
+    if (num_threads > out_size) num_threads = out_size;
+    if (total < 65536 || num_threads <= 1) {
+        InitTask t = { weights, 0, out_size, in_size, limit, seed, stream };
+        init_rows_worker(&t);
+        return;
+    }
+
+    pthread_t *threads = (pthread_t*) malloc(num_threads * sizeof(pthread_t));
+    InitTask *tasks    = (InitTask*)  malloc(num_threads * sizeof(InitTask));
+    if (!threads || !tasks) {
+        // the serial fill needs no allocation and gives the same values
+        free(threads);
+        free(tasks);
+        InitTask t = { weights, 0, out_size, in_size, limit, seed, stream };
+        init_rows_worker(&t);
+        return;
+    }
+
+    int rows_per = (out_size + num_threads - 1) / num_threads;
+    int launched = 0;
+    for(int t = 0; t < num_threads; t++) {
+        int begin = t * rows_per;
+        int end   = begin + rows_per < out_size ? begin + rows_per : out_size;
+        if (begin >= end) break;
+        tasks[t] = (InitTask){ weights, begin, end, in_size, limit, seed, stream };
+        if (pthread_create(&threads[launched], NULL, init_rows_worker, &tasks[t]) == 0) {
+            launched++;
+        } else {
+            // fall back to filling this range on the calling thread
+            init_rows_worker(&tasks[t]);
+        }
+    }
+    for(int t = 0; t < launched; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+    free(tasks);
+}
+
 /*
  * init_network
  * ------------
  * Allocates arrays for layer_sizes, weights, and biases, and then
- * initializes them (random or zeros).
+ * initializes them (Xavier weights, zero biases) from the default seed.
  */
 void init_network(NeuralNet *net, int num_layers, const int *layer_sizes) {
+    init_network_ex(net, num_layers, layer_sizes, INIT_XAVIER, NN_DEFAULT_SEED, 0);
+}
+
+/*
+ * init_network_ex
+ * ---------------
+ * Same as init_network, with explicit scheme, seed and thread count.
+ */
+void init_network_ex(NeuralNet *net, int num_layers, const int *layer_sizes,
+                     InitScheme scheme, uint64_t seed, int num_threads) {
     net->num_layers = num_layers;
+    num_threads = resolve_threads(num_threads);
 
     // 1) Copy the layer_sizes array
     net->layer_sizes = (int*) malloc(num_layers * sizeof(int));
@@ -68,14 +170,13 @@ void init_network(NeuralNet *net, int num_layers, const int *layer_sizes) {
         // Allocate biases[i]
         net->biases[i] = (float*) malloc(out_size * sizeof(float));
 
-        // 4) Initialize weights randomly, biases to zero (or small random).
-        // TODO: consider better init like Xavier or He.
+        // 4) Initialize weights from the layer's RNG stream, biases to zero.
+        float limit = init_limit(scheme, in_size, out_size);
+        uint64_t stream = rng_substream(RNG_STREAM_INIT, (uint64_t)i);
+        fill_weights(net->weights[i], out_size, in_size, limit, seed, stream, num_threads);
+
         for(int out_n = 0; out_n < out_size; out_n++) {
-            for(int in_n = 0; in_n < in_size; in_n++) {
-                // random float in range [-0.5, 0.5]
-                net->weights[i][out_n][in_n] = ((float) rand() / RAND_MAX) - 0.5f;
-            }
-            net->biases[i][out_n] = 0.0f; // or small random
+            net->biases[i][out_n] = 0.0f;
         }
     }
 }
@@ -300,4 +401,279 @@ void backprop(NeuralNet *net, const float *input, const float *target, float lr)
         free(delta[i]);
     }
     free(delta);
-}
\ No newline at end of file
+}
+/*
+ * init_grads / free_grads / zero_grads / reduce_grads
+ * ---------------------------------------------------
+ * Gradient accumulators for mini-batch training.
+ */
+void init_grads(NetGrads *grads, const NeuralNet *net) {
+    int L = net->num_layers;
+    grads->num_layers  = L;
+    grads->layer_sizes = (int*)    malloc(L * sizeof(int));
+    grads->dW          = (float**) malloc((L - 1) * sizeof(float*));
+    grads->db          = (float**) malloc((L - 1) * sizeof(float*));
+    grads->activations = (float**) malloc(L * sizeof(float*));
+    grads->delta       = (float**) malloc(L * sizeof(float*));
+    if (!grads->layer_sizes || !grads->dW || !grads->db || !grads->activations || !grads->delta) {
+        fprintf(stderr, "Error: failed to allocate memory for gradients.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(int i = 0; i < L; i++) {
+        grads->layer_sizes[i] = net->layer_sizes[i];
+        grads->activations[i] = (float*) malloc(net->layer_sizes[i] * sizeof(float));
+        grads->delta[i]       = (float*) malloc(net->layer_sizes[i] * sizeof(float));
+        if (!grads->activations[i] || !grads->delta[i]) {
+            fprintf(stderr, "Error: failed to allocate memory for gradient scratch.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for(int i = 0; i < L - 1; i++) {
+        size_t n = (size_t)net->layer_sizes[i + 1] * net->layer_sizes[i];
+        grads->dW[i] = (float*) calloc(n, sizeof(float));
+        grads->db[i] = (float*) calloc(net->layer_sizes[i + 1], sizeof(float));
+        if (!grads->dW[i] || !grads->db[i]) {
+            fprintf(stderr, "Error: failed to allocate memory for gradients.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void free_grads(NetGrads *grads) {
+    for(int i = 0; i < grads->num_layers - 1; i++) {
+        free(grads->dW[i]);
+        free(grads->db[i]);
+    }
+    for(int i = 0; i < grads->num_layers; i++) {
+        free(grads->activations[i]);
+        free(grads->delta[i]);
+    }
+    free(grads->dW);
+    free(grads->db);
+    free(grads->activations);
+    free(grads->delta);
+    free(grads->layer_sizes);
+
+    grads->dW = NULL;
+    grads->db = NULL;
+    grads->activations = NULL;
+    grads->delta = NULL;
+    grads->layer_sizes = NULL;
+    grads->num_layers = 0;
+}
+
+void zero_grads(NetGrads *grads) {
+    for(int i = 0; i < grads->num_layers - 1; i++) {
+        size_t n = (size_t)grads->layer_sizes[i + 1] * grads->layer_sizes[i];
+        memset(grads->dW[i], 0, n * sizeof(float));
+        memset(grads->db[i], 0, grads->layer_sizes[i + 1] * sizeof(float));
+    }
+}
+
+// [begin, end) of part `part` when n items are split into num_parts
+static void part_range(size_t n, int part, int num_parts, size_t *begin, size_t *end) {
+    *begin = n * (size_t)part / (size_t)num_parts;
+    *end   = n * (size_t)(part + 1) / (size_t)num_parts;
+}
+
+void reduce_grads(NetGrads *dst, const NetGrads *srcs, int num_srcs, int part, int num_parts) {
+    for(int i = 0; i < dst->num_layers - 1; i++) {
+        size_t n = (size_t)dst->layer_sizes[i + 1] * dst->layer_sizes[i];
+        size_t begin, end;
+
+        // sum in source order, so the result only depends on num_srcs
+        part_range(n, part, num_parts, &begin, &end);
+        float *d = dst->dW[i];
+        for(int s = 0; s < num_srcs; s++) {
+            const float *g = srcs[s].dW[i];
+            for(size_t k = begin; k < end; k++) {
+                d[k] += g[k];
+            }
+        }
+
+        part_range((size_t)dst->layer_sizes[i + 1], part, num_parts, &begin, &end);
+        d = dst->db[i];
+        for(int s = 0; s < num_srcs; s++) {
+            const float *g = srcs[s].db[i];
+            for(size_t k = begin; k < end; k++) {
+                d[k] += g[k];
+            }
+        }
+    }
+}
+
+/*
+ * accumulate_gradients
+ * --------------------
+ * Same forward/backward math as backprop(), but instead of updating the
+ * weights it adds dL/dW and dL/db into `grads`. The network is read-only,
+ * so several threads can run this concurrently, each with its own NetGrads.
+ */
+float accumulate_gradients(const NeuralNet *net, const float *input, const float *target,
+                           NetGrads *grads, float *output) {
+    float **act   = grads->activations;
+    float **delta = grads->delta;
+    int L = net->num_layers;
+
+    /* ---- Forward pass storing all layer activations ---- */
+    memcpy(act[0], input, net->layer_sizes[0] * sizeof(float));
+    for(int layer_idx = 0; layer_idx < L - 1; layer_idx++) {
+        int in_size  = net->layer_sizes[layer_idx];
+        int out_size = net->layer_sizes[layer_idx + 1];
+
+        for(int out_n = 0; out_n < out_size; out_n++) {
+            const float *w = net->weights[layer_idx][out_n];
+            float sum = 0.0f;
+            for(int in_n = 0; in_n < in_size; in_n++) {
+                sum += w[in_n] * act[layer_idx][in_n];
+            }
+            sum += net->biases[layer_idx][out_n];
+            act[layer_idx + 1][out_n] = sigmoidf(sum);
+        }
+    }
+
+    /* ---- Output error (MSE through sigmoid) ---- */
+    int out_idx  = L - 1;
+    int out_size = net->layer_sizes[out_idx];
+    float loss = 0.0f;
+    for(int j = 0; j < out_size; j++) {
+        float a_out = act[out_idx][j];
+        float error = a_out - target[j];
+        loss += error * error;
+        delta[out_idx][j] = error * (a_out * (1.0f - a_out));
+        if (output) output[j] = a_out;
+    }
+
+    /* ---- Backpropagate through hidden layers ---- */
+    for(int layer_idx = L - 2; layer_idx > 0; layer_idx--) {
+        int layer_size      = net->layer_sizes[layer_idx];
+        int next_layer_size = net->layer_sizes[layer_idx + 1];
+
+        // delta[l] = W[l]^T * delta[l+1], walking W row by row
+        for(int i = 0; i < layer_size; i++) {
+            delta[layer_idx][i] = 0.0f;
+        }
+        for(int k = 0; k < next_layer_size; k++) {
+            const float *w = net->weights[layer_idx][k];
+            float d = delta[layer_idx + 1][k];
+            for(int i = 0; i < layer_size; i++) {
+                delta[layer_idx][i] += w[i] * d;
+            }
+        }
+        for(int i = 0; i < layer_size; i++) {
+            float a = act[layer_idx][i];
+            delta[layer_idx][i] *= a * (1.0f - a);
+        }
+    }
+
+    /* ---- Accumulate dW = delta[l+1] * a_l^T, db = delta[l+1] ---- */
+    for(int layer_idx = 0; layer_idx < L - 1; layer_idx++) {
+        int in_size  = net->layer_sizes[layer_idx];
+        int out_size = net->layer_sizes[layer_idx + 1];
+        const float *a_in = act[layer_idx];
+
+        for(int out_n = 0; out_n < out_size; out_n++) {
+            float d = delta[layer_idx + 1][out_n];
+            float *g = grads->dW[layer_idx] + (size_t)out_n * in_size;
+            for(int in_n = 0; in_n < in_size; in_n++) {
+                g[in_n] += d * a_in[in_n];
+            }
+            grads->db[layer_idx][out_n] += d;
+        }
+    }
+
+    return loss;
+}
+
+/*
+ * save_network / load_network
+ * ---------------------------
+ * Binary checkpoint format (native endianness):
+ *   magic "NNC1", int num_layers, int layer_sizes[num_layers],
+ *   then for each layer i: weights[i] row by row, followed by biases[i].
+ */
+static const char CHECKPOINT_MAGIC[4] = { 'N', 'N', 'C', '1' };
+
+int save_network(const NeuralNet *net, const char *filepath) {
+    FILE *fp = fopen(filepath, "wb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open checkpoint file for writing: %s\n", filepath);
+        return 1;
+    }
+
+    int ok = fwrite(CHECKPOINT_MAGIC, 1, 4, fp) == 4
+          && fwrite(&net->num_layers, sizeof(int), 1, fp) == 1
+          && fwrite(net->layer_sizes, sizeof(int), net->num_layers, fp) == (size_t)net->num_layers;
+
+    for(int i = 0; ok && i < net->num_layers - 1; i++) {
+        int in_size  = net->layer_sizes[i];
+        int out_size = net->layer_sizes[i + 1];
+        for(int r = 0; ok && r < out_size; r++) {
+            ok = fwrite(net->weights[i][r], sizeof(float), in_size, fp) == (size_t)in_size;
+        }
+        ok = ok && fwrite(net->biases[i], sizeof(float), out_size, fp) == (size_t)out_size;
+    }
+
+    if (fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Failed to write checkpoint: %s\n", filepath);
+        return 1;
+    }
+    return 0;
+}
+
+int load_network(NeuralNet *net, const char *filepath) {
+    FILE *fp = fopen(filepath, "rb");
+    if (!fp) {
+        fprintf(stderr, "Cannot open checkpoint file: %s\n", filepath);
+        return 1;
+    }
+
+    char magic[4];
+    int num_layers = 0;
+    if (fread(magic, 1, 4, fp) != 4 || memcmp(magic, CHECKPOINT_MAGIC, 4) != 0
+        || fread(&num_layers, sizeof(int), 1, fp) != 1 || num_layers < 2) {
+        fprintf(stderr, "Invalid checkpoint header: %s\n", filepath);
+        fclose(fp);
+        return 1;
+    }
+
+    int *sizes = (int*) malloc(num_layers * sizeof(int));
+    if (!sizes || fread(sizes, sizeof(int), num_layers, fp) != (size_t)num_layers) {
+        fprintf(stderr, "Invalid checkpoint header: %s\n", filepath);
+        free(sizes);
+        fclose(fp);
+        return 1;
+    }
+    for(int i = 0; i < num_layers; i++) {
+        if (sizes[i] <= 0) {
+            fprintf(stderr, "Invalid layer size in checkpoint: %s\n", filepath);
+            free(sizes);
+            fclose(fp);
+            return 1;
+        }
+    }
+
+    // Allocate with the right shapes, then overwrite the values from disk
+    init_network_ex(net, num_layers, sizes, INIT_UNIFORM, 0, 1);
+    free(sizes);
+
+    int ok = 1;
+    for(int i = 0; ok && i < num_layers - 1; i++) {
+        int in_size  = net->layer_sizes[i];
+        int out_size = net->layer_sizes[i + 1];
+        for(int r = 0; ok && r < out_size; r++) {
+            ok = fread(net->weights[i][r], sizeof(float), in_size, fp) == (size_t)in_size;
+        }
+        ok = ok && fread(net->biases[i], sizeof(float), out_size, fp) == (size_t)out_size;
+    }
+    fclose(fp);
+
+    if (!ok) {
+        fprintf(stderr, "Truncated checkpoint: %s\n", filepath);
+        free_network(net);
+        return 1;
+    }
+    return 0;
+}
@@ -1,6 +1,18 @@
 #ifndef NEURALNET_H
 #define NEURALNET_H
 
+#include <stdint.h>
+
+// Weight initialization schemes (biases are always zeroed)
+typedef enum {
+    INIT_UNIFORM = 0,   // uniform in [-0.5, 0.5] (the original scheme)
+    INIT_XAVIER,        // uniform in +/- sqrt(6 / (fan_in + fan_out)), suits sigmoid/tanh
+    INIT_HE             // uniform in +/- sqrt(6 / fan_in), suits ReLU
+} InitScheme;
+
+// Default seed used by init_network()
+#define NN_DEFAULT_SEED 42ULL
+
 typedef struct {
     int num_layers;       // total number of layers
     int *layer_sizes;     // array of layer sizes: length = num_layers
@@ -15,6 +27,23 @@ typedef struct {
 
 } NeuralNet;
 
+/*
+ * Gradient accumulator for mini-batch training.
+ * dW[i] has the same shape as weights[i], stored row-major as one flat
+ * array of [layer_sizes[i+1] * layer_sizes[i]]; db[i] matches biases[i].
+ * activations/delta are per-sample scratch so accumulate_gradients()
+ * doesn't allocate. Use one NetGrads per thread.
+ */
+typedef struct {
+    int num_layers;
+    int *layer_sizes;
+    float **dW;
+    float **db;
+
+    float **activations;  // [num_layers][layer_sizes[i]]
+    float **delta;        // [num_layers][layer_sizes[i]], delta[0] unused
+} NetGrads;
+
 /**
  * @brief Initializes a neural network with the given layer sizes.
  *
@@ -29,6 +58,19 @@ typedef struct {
  */
 void init_network(NeuralNet *net, int num_layers, const int *layer_sizes);
 
+/**
+ * @brief Like init_network(), but with an explicit scheme, seed and thread count.
+ *
+ * @param scheme        Weight initialization scheme (see InitScheme).
+ * @param seed          RNG seed. The same seed always gives the same weights.
+ * @param num_threads   Threads used to fill the weights; <= 0 means one per CPU.
+ *
+ * Each weight is drawn from a counter-based RNG keyed by (seed, layer, index),
+ * so the result is bit-identical regardless of num_threads.
+ */
+void init_network_ex(NeuralNet *net, int num_layers, const int *layer_sizes,
+                     InitScheme scheme, uint64_t seed, int num_threads);
+
 /**
  * @brief Frees all dynamically allocated memory in the NeuralNet.
  *
@@ -67,6 +109,55 @@ void forward(const NeuralNet *net, const float *input, float *output);
  */
 void backprop(NeuralNet *net, const float *input, const float *target, float lr);
 
+/**
+ * @brief Allocates a zeroed gradient accumulator shaped like `net`.
+ */
+void init_grads(NetGrads *grads, const NeuralNet *net);
+
+/**
+ * @brief Frees all memory in a NetGrads.
+ */
+void free_grads(NetGrads *grads);
+
+/**
+ * @brief Resets all accumulated gradients to zero.
+ */
+void zero_grads(NetGrads *grads);
+
+/**
+ * @brief Adds srcs[0..num_srcs-1] into `dst` (all the same shape), but only
+ *        for slice `part` of `num_parts` of every parameter array.
+ *
+ * Calling this with part = 0..num_parts-1 from different threads reduces
+ * the whole gradient in parallel; the slices never overlap.
+ */
+void reduce_grads(NetGrads *dst, const NetGrads *srcs, int num_srcs, int part, int num_parts);
+
+/**
+ * @brief Runs forward + backward for one sample and adds its MSE gradients
+ *        into `grads`, without touching the network.
+ *
+ * @param output  Optional (may be NULL): receives the network output for `input`.
+ *
+ * @return The sample's squared error, sum over outputs of (output - target)^2.
+ */
+float accumulate_gradients(const NeuralNet *net, const float *input, const float *target,
+                           NetGrads *grads, float *output);
+
+/**
+ * @brief Writes the network topology, weights and biases to a binary file.
+ *
+ * @return 0 on success, non-zero on error.
+ */
+int save_network(const NeuralNet *net, const char *filepath);
+
+/**
+ * @brief Loads a network written by save_network(). `net` must not be initialized.
+ *
+ * @return 0 on success, non-zero on error.
+ */
+int load_network(NeuralNet *net, const char *filepath);
+
 
 
 #endif // NEURALNET_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+/* optimizer.c */
+
+#include "optimizer.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+int parse_optimizer(const char *name, OptimizerType *type) {
+    if (strcmp(name, "sgd") == 0)           *type = OPT_SGD;
+    else if (strcmp(name, "momentum") == 0) *type = OPT_MOMENTUM;
+    else if (strcmp(name, "adam") == 0)     *type = OPT_ADAM;
+    else return 1;
+    return 0;
+}
+
+const char *optimizer_name(OptimizerType type) {
+    switch(type) {
+        case OPT_MOMENTUM: return "momentum";
+        case OPT_ADAM:     return "adam";
+        case OPT_SGD:
+        default:           return "sgd";
+    }
+}
+
+void init_optimizer(Optimizer *opt, OptimizerType type, const NeuralNet *net) {
+    memset(opt, 0, sizeof(*opt));
+    opt->type     = type;
+    opt->momentum = 0.9f;
+    opt->beta1    = 0.9f;
+    opt->beta2    = 0.999f;
+    opt->eps      = 1e-8f;
+
+    if (type == OPT_MOMENTUM || type == OPT_ADAM) {
+        init_grads(&opt->m, net);
+        opt->has_m = 1;
+    }
+    if (type == OPT_ADAM) {
+        init_grads(&opt->v, net);
+        opt->has_v = 1;
+    }
+}
+
+void free_optimizer(Optimizer *opt) {
+    if (opt->has_m) free_grads(&opt->m);
+    if (opt->has_v) free_grads(&opt->v);
+    opt->has_m = opt->has_v = 0;
+}
+
+/*
+ * update_params
+ * -------------
+ * Updates one parameter array of n values in place. Shared by the weight
+ * rows and the biases so both go through exactly the same rule.
+ */
+static void update_params(Optimizer *opt, float *w, const float *g, float *m, float *v,
+                          size_t n, float lr, float scale, float bc1, float bc2) {
+    switch(opt->type) {
+        case OPT_MOMENTUM:
+            for(size_t k = 0; k < n; k++) {
+                m[k] = opt->momentum * m[k] + scale * g[k];
+                w[k] -= lr * m[k];
+            }
+            break;
+        case OPT_ADAM:
+            for(size_t k = 0; k < n; k++) {
+                float gk = scale * g[k];
+                m[k] = opt->beta1 * m[k] + (1.0f - opt->beta1) * gk;
+                v[k] = opt->beta2 * v[k] + (1.0f - opt->beta2) * gk * gk;
+                w[k] -= lr * (m[k] / bc1) / (sqrtf(v[k] / bc2) + opt->eps);
+            }
+            break;
+        case OPT_SGD:
+        default:
+            for(size_t k = 0; k < n; k++) {
+                w[k] -= lr * scale * g[k];
+            }
+            break;
+    }
+}
+
+void optimizer_step(Optimizer *opt, NeuralNet *net, const NetGrads *grads, float lr, float scale) {
+    opt->step++;
+    float bc1 = 1.0f, bc2 = 1.0f;
+    if (opt->type == OPT_ADAM) {
+        bc1 = 1.0f - powf(opt->beta1, (float)opt->step);
+        bc2 = 1.0f - powf(opt->beta2, (float)opt->step);
+    }
+
+    for(int i = 0; i < net->num_layers - 1; i++) {
+        int in_size  = net->layer_sizes[i];
+        int out_size = net->layer_sizes[i + 1];
+
+        // weights are stored row by row, gradients flat
+        for(int r = 0; r < out_size; r++) {
+            size_t off = (size_t)r * in_size;
+            update_params(opt, net->weights[i][r], grads->dW[i] + off,
+                          opt->has_m ? opt->m.dW[i] + off : NULL,
+                          opt->has_v ? opt->v.dW[i] + off : NULL,
+                          in_size, lr, scale, bc1, bc2);
+        }
+        update_params(opt, net->biases[i], grads->db[i],
+                      opt->has_m ? opt->m.db[i] : NULL,
+                      opt->has_v ? opt->v.db[i] : NULL,
+                      out_size, lr, scale, bc1, bc2);
+    }
+}
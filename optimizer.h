@@ -0,0 +1,59 @@
+/* optimizer.h */
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "neuralnet.h"
+
+typedef enum {
+    OPT_SGD = 0,     // w -= lr * g
+    OPT_MOMENTUM,    // v = mu * v + g;  w -= lr * v
+    OPT_ADAM         // Adam with bias correction
+} OptimizerType;
+
+typedef struct {
+    OptimizerType type;
+    float momentum;    // mu for OPT_MOMENTUM (e.g. 0.9)
+    float beta1;       // Adam first-moment decay (e.g. 0.9)
+    float beta2;       // Adam second-moment decay (e.g. 0.999)
+    float eps;         // Adam epsilon (e.g. 1e-8)
+    long step;         // number of updates applied so far
+
+    // Optimizer state, shaped like the network's gradients.
+    // m: momentum velocity / Adam first moment; v: Adam second moment.
+    NetGrads m;
+    NetGrads v;
+    int has_m, has_v;
+} Optimizer;
+
+/**
+ * @brief Parses "sgd", "momentum" or "adam".
+ *
+ * @return 0 on success, non-zero if the name is unknown.
+ */
+int parse_optimizer(const char *name, OptimizerType *type);
+
+/**
+ * @brief Returns the canonical name of an optimizer type.
+ */
+const char *optimizer_name(OptimizerType type);
+
+/**
+ * @brief Initializes optimizer state for `net` with default hyperparameters.
+ */
+void init_optimizer(Optimizer *opt, OptimizerType type, const NeuralNet *net);
+
+/**
+ * @brief Frees optimizer state.
+ */
+void free_optimizer(Optimizer *opt);
+
+/**
+ * @brief Applies one update to `net` from accumulated gradients.
+ *
+ * @param lr     Learning rate.
+ * @param scale  Multiplier applied to the gradients first (e.g. 1/batch_size).
+ */
+void optimizer_step(Optimizer *opt, NeuralNet *net, const NetGrads *grads, float lr, float scale);
+
+#endif // OPTIMIZER_H
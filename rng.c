@@ -0,0 +1,64 @@
+/* rng.c */
+
+#include "rng.h"
+#include <math.h>
+
+// splitmix64 finalizer: a strong bijective 64-bit mixer
+static uint64_t mix64(uint64_t z) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t rng_at(uint64_t seed, uint64_t stream, uint64_t counter) {
+    // Key the counter with (seed, stream), then mix twice so neighbouring
+    // counters and neighbouring streams don't produce correlated output.
+    uint64_t key = mix64(seed ^ mix64(stream));
+    return mix64(key ^ mix64(counter));
+}
+
+float rng_uniform_at(uint64_t seed, uint64_t stream, uint64_t counter) {
+    // top 24 bits -> exactly representable float in [0, 1)
+    return (float)(rng_at(seed, stream, counter) >> 40) * (1.0f / 16777216.0f);
+}
+
+uint64_t rng_substream(uint64_t stream, uint64_t index) {
+    return mix64(stream * 0x100000001B3ULL + index);
+}
+
+void rng_init(Rng *rng, uint64_t seed, uint64_t stream) {
+    rng->seed    = seed;
+    rng->stream  = stream;
+    rng->counter = 0;
+}
+
+uint64_t rng_next(Rng *rng) {
+    return rng_at(rng->seed, rng->stream, rng->counter++);
+}
+
+float rng_uniform(Rng *rng) {
+    return (float)(rng_next(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+int rng_below(Rng *rng, int n) {
+    // Lemire's multiply-shift reduction (bias is negligible for n << 2^32)
+    uint64_t r = rng_next(rng) >> 32;
+    return (int)((r * (uint64_t)n) >> 32);
+}
+
+float rng_normal(Rng *rng) {
+    // Box-Muller; 1 - u keeps the log argument in (0, 1]
+    float u1 = 1.0f - rng_uniform(rng);
+    float u2 = rng_uniform(rng);
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.28318530718f * u2);
+}
+
+void rng_shuffle(Rng *rng, int *arr, int n) {
+    for (int i = n - 1; i > 0; i--) {
+        int j = rng_below(rng, i + 1);
+        int tmp = arr[i];
+        arr[i] = arr[j];
+        arr[j] = tmp;
+    }
+}
@@ -0,0 +1,78 @@
+/* rng.h */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/*
+ * Counter-based random number generator (splitmix64 style).
+ *
+ * Every random value is a pure function of (seed, stream, counter), so any
+ * element of a buffer can be generated independently of the others. That
+ * makes parallel fills bit-identical no matter how the work is split
+ * between threads, and lets separate consumers (weight init, shuffling,
+ * augmentation) draw from the same seed without disturbing each other.
+ */
+
+// Well-known stream ids. Sub-streams (e.g. one per layer) can be derived
+// with rng_substream().
+enum {
+    RNG_STREAM_INIT    = 1,
+    RNG_STREAM_SHUFFLE = 2,
+    RNG_STREAM_AUGMENT = 3
+};
+
+typedef struct {
+    uint64_t seed;
+    uint64_t stream;
+    uint64_t counter;   // next position in the stream
+} Rng;
+
+/**
+ * @brief Returns the 64-bit random value at position `counter` of `stream`.
+ */
+uint64_t rng_at(uint64_t seed, uint64_t stream, uint64_t counter);
+
+/**
+ * @brief Returns a float in [0, 1) at position `counter` of `stream`.
+ */
+float rng_uniform_at(uint64_t seed, uint64_t stream, uint64_t counter);
+
+/**
+ * @brief Combines a stream id with an index (layer, sample, ...) into a new
+ *        stream id.
+ */
+uint64_t rng_substream(uint64_t stream, uint64_t index);
+
+/**
+ * @brief Initializes a sequential view over (seed, stream), starting at 0.
+ */
+void rng_init(Rng *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Returns the next 64-bit value and advances the counter.
+ */
+uint64_t rng_next(Rng *rng);
+
+/**
+ * @brief Returns the next float in [0, 1).
+ */
+float rng_uniform(Rng *rng);
+
+/**
+ * @brief Returns the next integer in [0, n). n must be > 0.
+ */
+int rng_below(Rng *rng, int n);
+
+/**
+ * @brief Returns the next sample from a standard normal distribution.
+ */
+float rng_normal(Rng *rng);
+
+/**
+ * @brief Fisher-Yates shuffle of an int array (e.g. sample indices).
+ */
+void rng_shuffle(Rng *rng, int *arr, int n);
+
+#endif // RNG_H
@@ -0,0 +1,230 @@
+/* train.c */
+
+#include "train.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>     // for sysconf()
+
+static int argmax(const float *v, int n) {
+    int best = 0;
+    for(int j = 1; j < n; j++) {
+        if (v[j] > v[best]) best = j;
+    }
+    return best;
+}
+
+/*
+ * run_slice
+ * ---------
+ * Processes worker `tid`'s share of the current batch (tid < active).
+ */
+static void run_slice(Trainer *tr, int tid) {
+    const NeuralNet *net = tr->net;
+    int out_size = net->layer_sizes[net->num_layers - 1];
+    int begin = (int)((long long)tr->batch_n * tid / tr->active);
+    int end   = (int)((long long)tr->batch_n * (tid + 1) / tr->active);
+
+    NetGrads *g = &tr->grads[tid];
+    float *target = tr->target[tid];
+    float *output = tr->output[tid];
+
+    zero_grads(g);
+    float loss = 0.0f;
+    int correct = 0;
+    for(int s = begin; s < end; s++) {
+        const float *input = tr->inputs[s];
+        if (tr->aug) {
+            augment_image(tr->aug, tr->aug_seed, tr->aug_keys[s], input,
+                          tr->aug_image[tid], tr->img_w, tr->img_h, tr->aug_scratch[tid]);
+            input = tr->aug_image[tid];
+        }
+
+        int label = tr->labels[s];
+        target[label] = 1.0f;
+        loss += accumulate_gradients(net, input, target, g, output);
+        target[label] = 0.0f;
+        if (argmax(output, out_size) == label) correct++;
+    }
+    tr->loss[tid]    = loss;
+    tr->correct[tid] = correct;
+}
+
+/*
+ * reduce_part
+ * -----------
+ * Sums the active threads' gradients into grads[0] for worker `tid`'s
+ * share of the parameters.
+ */
+static void reduce_part(Trainer *tr, int tid) {
+    reduce_grads(&tr->grads[0], &tr->grads[1], tr->active - 1, tid, tr->num_threads);
+}
+
+static void *worker_main(void *arg) {
+    TrainerWorker *w = (TrainerWorker*) arg;
+    Trainer *tr = w->tr;
+    int tid = w->tid;
+
+    for(;;) {
+        pthread_barrier_wait(&tr->start);
+        if (tr->shutdown) break;
+        if (tid < tr->active) run_slice(tr, tid);
+        pthread_barrier_wait(&tr->computed);
+        reduce_part(tr, tid);
+        pthread_barrier_wait(&tr->done);
+    }
+    return NULL;
+}
+
+void init_trainer(Trainer *tr, const NeuralNet *net, int num_threads) {
+    if (num_threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = n > 0 ? (int)n : 1;
+    }
+    memset(tr, 0, sizeof(*tr));
+    tr->num_threads = num_threads;
+    tr->grads   = (NetGrads*) malloc(num_threads * sizeof(NetGrads));
+    tr->loss    = (float*)    malloc(num_threads * sizeof(float));
+    tr->correct = (int*)      malloc(num_threads * sizeof(int));
+    tr->target  = (float**)   malloc(num_threads * sizeof(float*));
+    tr->output  = (float**)   malloc(num_threads * sizeof(float*));
+    tr->threads = (pthread_t*)     malloc((num_threads > 1 ? num_threads - 1 : 1) * sizeof(pthread_t));
+    tr->workers = (TrainerWorker*) malloc((num_threads > 1 ? num_threads - 1 : 1) * sizeof(TrainerWorker));
+    if (!tr->grads || !tr->loss || !tr->correct || !tr->target || !tr->output
+        || !tr->threads || !tr->workers) {
+        fprintf(stderr, "Error: failed to allocate trainer.\n");
+        exit(EXIT_FAILURE);
+    }
+    int out_size = net->layer_sizes[net->num_layers - 1];
+    for(int t = 0; t < num_threads; t++) {
+        init_grads(&tr->grads[t], net);
+        tr->target[t] = (float*) calloc(out_size, sizeof(float));
+        tr->output[t] = (float*) malloc(out_size * sizeof(float));
+        if (!tr->target[t] || !tr->output[t]) {
+            fprintf(stderr, "Error: failed to allocate trainer scratch.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (num_threads > 1) {
+        pthread_barrier_init(&tr->start,    NULL, num_threads);
+        pthread_barrier_init(&tr->computed, NULL, num_threads);
+        pthread_barrier_init(&tr->done,     NULL, num_threads);
+        for(int t = 0; t < num_threads - 1; t++) {
+            tr->workers[t].tr  = tr;
+            tr->workers[t].tid = t + 1;
+            if (pthread_create(&tr->threads[t], NULL, worker_main, &tr->workers[t]) != 0) {
+                fprintf(stderr, "Error: failed to create trainer thread.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+}
+
+void free_trainer(Trainer *tr) {
+    if (tr->num_threads > 1) {
+        tr->shutdown = 1;
+        pthread_barrier_wait(&tr->start);
+        for(int t = 0; t < tr->num_threads - 1; t++) {
+            pthread_join(tr->threads[t], NULL);
+        }
+        pthread_barrier_destroy(&tr->start);
+        pthread_barrier_destroy(&tr->computed);
+        pthread_barrier_destroy(&tr->done);
+    }
+    for(int t = 0; t < tr->num_threads; t++) {
+        free_grads(&tr->grads[t]);
+        free(tr->target[t]);
+        free(tr->output[t]);
+    }
+    if (tr->aug) {
+        for(int t = 0; t < tr->num_threads; t++) {
+            free(tr->aug_image[t]);
+            free(tr->aug_scratch[t]);
+        }
+        free(tr->aug_image);
+        free(tr->aug_scratch);
+    }
+    free(tr->grads);
+    free(tr->loss);
+    free(tr->correct);
+    free(tr->target);
+    free(tr->output);
+    free(tr->threads);
+    free(tr->workers);
+    memset(tr, 0, sizeof(*tr));
+}
+
+void trainer_set_augment(Trainer *tr, const AugmentConfig *aug, uint64_t seed,
+                         int width, int height) {
+    int scratch_size = augment_scratch_size(aug, width, height);
+    tr->aug_image   = (float**) malloc(tr->num_threads * sizeof(float*));
+    tr->aug_scratch = (float**) malloc(tr->num_threads * sizeof(float*));
+    if (!tr->aug_image || !tr->aug_scratch) {
+        fprintf(stderr, "Error: failed to allocate augmentation buffers.\n");
+        exit(EXIT_FAILURE);
+    }
+    for(int t = 0; t < tr->num_threads; t++) {
+        tr->aug_image[t]   = (float*) malloc((size_t)width * height * sizeof(float));
+        tr->aug_scratch[t] = (float*) malloc((size_t)scratch_size * sizeof(float));
+        if (!tr->aug_image[t] || !tr->aug_scratch[t]) {
+            fprintf(stderr, "Error: failed to allocate augmentation buffers.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    tr->aug      = aug;
+    tr->aug_seed = seed;
+    tr->img_w    = width;
+    tr->img_h    = height;
+}
+
+float train_batch(Trainer *tr, NeuralNet *net, Optimizer *opt, float lr,
+                  const float *const *inputs, const int *labels, const uint64_t *aug_keys,
+                  int n, int *correct) {
+    tr->net      = net;
+    tr->inputs   = inputs;
+    tr->labels   = labels;
+    tr->aug_keys = aug_keys;
+    tr->batch_n  = n;
+    tr->active   = n < tr->num_threads ? n : tr->num_threads;
+
+    if (tr->active > 1) {
+        pthread_barrier_wait(&tr->start);
+        run_slice(tr, 0);
+        pthread_barrier_wait(&tr->computed);
+        reduce_part(tr, 0);
+        pthread_barrier_wait(&tr->done);
+    } else {
+        run_slice(tr, 0);
+    }
+
+    float loss = tr->loss[0];
+    int batch_correct = tr->correct[0];
+    for(int t = 1; t < tr->active; t++) {
+        loss += tr->loss[t];
+        batch_correct += tr->correct[t];
+    }
+
+    optimizer_step(opt, net, &tr->grads[0], lr, 1.0f / (float)n);
+
+    if (correct) *correct += batch_correct;
+    return loss;
+}
+
+int evaluate(const NeuralNet *net, const Dataset *ds) {
+    int out_size = net->layer_sizes[net->num_layers - 1];
+    float *output = (float*) malloc(out_size * sizeof(float));
+    if (!output) {
+        fprintf(stderr, "Error: failed to allocate evaluation buffer.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int correct = 0;
+    for(int i = 0; i < ds->num_samples; i++) {
+        forward(net, ds->features[i], output);
+        if (argmax(output, out_size) == (int)ds->labels[i]) correct++;
+    }
+
+    free(output);
+    return correct;
+}
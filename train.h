@@ -0,0 +1,107 @@
+/* train.h */
+
+#ifndef TRAIN_H
+#define TRAIN_H
+
+#include <pthread.h>
+#include "neuralnet.h"
+#include "optimizer.h"
+#include "data.h"
+#include "augment.h"
+
+/*
+ * Mini-batch trainer. A batch is split into contiguous slices over
+ * min(num_threads, batch size) threads; each accumulates gradients into its
+ * own NetGrads. All threads then sum those into grads[0], each over its own
+ * range of parameters, before a single optimizer step. A batch that fits on
+ * one thread runs on the caller alone, with no synchronization at all.
+ * Worker threads are persistent and synchronized with barriers, so there's
+ * no thread creation cost per batch. The calling thread acts as worker 0.
+ *
+ * With augmentation enabled (trainer_set_augment), each worker also
+ * augments its own slice right before using it, so augmented copies are
+ * never materialized for the whole dataset and augmentation scales with
+ * the same threads as training.
+ */
+typedef struct Trainer Trainer;
+
+typedef struct {
+    Trainer *tr;
+    int tid;
+} TrainerWorker;
+
+struct Trainer {
+    int num_threads;
+    NetGrads *grads;        // [num_threads]
+    float *loss;            // per-thread partial loss
+    int *correct;           // per-thread partial correct count
+    float **target;         // [num_threads][outputs], one-hot scratch (kept all zero)
+    float **output;         // [num_threads][outputs], network output scratch
+
+    // current batch, published to workers between barriers
+    const NeuralNet *net;
+    const float *const *inputs;
+    const int *labels;
+    const uint64_t *aug_keys;
+    int batch_n;
+    int active;             // threads with a non-empty slice this batch
+    int shutdown;
+
+    // optional augmentation (aug == NULL: disabled)
+    const AugmentConfig *aug;
+    uint64_t aug_seed;
+    int img_w, img_h;
+    float **aug_image;      // [num_threads][img_w * img_h]
+    float **aug_scratch;    // [num_threads][augment_scratch_size()]
+
+    pthread_t *threads;     // [num_threads - 1]
+    TrainerWorker *workers; // [num_threads - 1], worker t has tid t + 1
+    pthread_barrier_t start, computed, done;
+};
+
+/**
+ * @brief Sets up per-thread gradient buffers and starts the worker threads.
+ *
+ * @param num_threads  Number of threads (including the caller); <= 0 means one per CPU.
+ */
+void init_trainer(Trainer *tr, const NeuralNet *net, int num_threads);
+
+/**
+ * @brief Stops the worker threads and frees all trainer memory.
+ */
+void free_trainer(Trainer *tr);
+
+/**
+ * @brief Enables per-batch augmentation of the training inputs.
+ *
+ * @param aug     Augmentation settings; must outlive the trainer.
+ * @param seed    Run seed for the augmentation RNG.
+ * @param width   Image width; inputs must be width * height pixels.
+ * @param height  Image height.
+ */
+void trainer_set_augment(Trainer *tr, const AugmentConfig *aug, uint64_t seed,
+                         int width, int height);
+
+/**
+ * @brief Trains on one mini-batch: accumulates gradients over n samples in
+ *        parallel, then applies one optimizer step with the mean gradient.
+ *
+ * @param inputs   n pointers to input vectors (size = layer_sizes[0]).
+ * @param labels   n class indices; targets are one-hot over the output layer.
+ * @param aug_keys n per-sample augmentation keys (see augment_image); only
+ *                 read when augmentation is enabled, may be NULL otherwise.
+ * @param correct  Optional (may be NULL): incremented by the number of samples
+ *                 the network classified correctly before the update.
+ *
+ * @return Summed squared error over the batch (before the update).
+ */
+float train_batch(Trainer *tr, NeuralNet *net, Optimizer *opt, float lr,
+                  const float *const *inputs, const int *labels, const uint64_t *aug_keys,
+                  int n, int *correct);
+
+/**
+ * @brief Counts how many samples of `ds` the network classifies correctly.
+ */
+int evaluate(const NeuralNet *net, const Dataset *ds);
+
+#endif // TRAIN_H